@@ -0,0 +1,80 @@
+#include "camerapath.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Uniform Catmull-Rom interpolation between p1 and p2.
+glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t) {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) +
+                   (p2 - p0) * t +
+                   (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                   (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+}
+
+CameraPath::CameraPath(const std::string& pathFile) {
+    std::ifstream file(pathFile);
+    if (!file) {
+        throw std::runtime_error("Failed to open camera path: " + pathFile);
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        CameraKeyframe key;
+        if (!(fields >> key.time
+                     >> key.position.x >> key.position.y >> key.position.z
+                     >> key.target.x >> key.target.y >> key.target.z)) {
+            throw std::runtime_error("Malformed keyframe in " + pathFile + " at line " + std::to_string(lineNumber));
+        }
+        keyframes.push_back(key);
+    }
+
+    if (keyframes.empty()) {
+        throw std::runtime_error("Camera path has no keyframes: " + pathFile);
+    }
+
+    std::sort(keyframes.begin(), keyframes.end(),
+              [](const CameraKeyframe& a, const CameraKeyframe& b) { return a.time < b.time; });
+}
+
+float CameraPath::duration() const {
+    return keyframes.back().time - keyframes.front().time;
+}
+
+CameraKeyframe CameraPath::sample(float time) const {
+    time += keyframes.front().time;
+    if (!std::isfinite(time) || time <= keyframes.front().time) return keyframes.front();
+    if (time >= keyframes.back().time) return keyframes.back();
+
+    // Find the segment [i, i + 1] that contains the requested time
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+                                 [](float t, const CameraKeyframe& key) { return t < key.time; });
+    size_t last = keyframes.size() - 1;
+    size_t i = std::min(static_cast<size_t>(next - keyframes.begin()) - 1, last - 1);
+
+    const CameraKeyframe& k0 = keyframes[i == 0 ? 0 : i - 1];
+    const CameraKeyframe& k1 = keyframes[i];
+    const CameraKeyframe& k2 = keyframes[i + 1];
+    const CameraKeyframe& k3 = keyframes[std::min(i + 2, last)];
+
+    float t = (time - k1.time) / (k2.time - k1.time);
+    return CameraKeyframe{
+        time,
+        catmullRom(k0.position, k1.position, k2.position, k3.position, t),
+        catmullRom(k0.target, k1.target, k2.target, k3.target, t)
+    };
+}
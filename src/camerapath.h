@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// A single camera pose on the animation timeline.
+struct CameraKeyframe {
+    float time;
+    glm::vec3 position;
+    glm::vec3 target;
+};
+
+// Keyframed camera path used by the batch renderer.
+// Poses between keyframes are interpolated with a Catmull-Rom spline so fly-arounds stay smooth.
+class CameraPath {
+public:
+    // Loads a path file. Each non-empty line that does not start with '#' holds
+    // "time px py pz tx ty tz". Keyframes are sorted by time after loading.
+    explicit CameraPath(const std::string& pathFile);
+
+    float duration() const;
+    CameraKeyframe sample(float time) const;
+
+private:
+    std::vector<CameraKeyframe> keyframes;
+};
@@ -32,6 +32,8 @@ struct Color {
         );
     }
 
+    bool operator==(const Color& other) const = default;
+
     // Declare the << operator to print colors
     friend std::ostream& operator<<(std::ostream& os, const Color& color);
 
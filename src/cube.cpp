@@ -1,11 +1,21 @@
 #include "cube.h"
+#include "scene.h"
 
 // Constructor implementation
 Cube::Cube(const glm::vec3& min, const glm::vec3& max, const Material& mat)
-    : min(min), max(max), Object(mat) {}
+    : Object(mat), min(min), max(max) {}
 
-// Optimized Ray intersection method
 Intersect Cube::rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const {
+    return intersect(min, max, rayOrigin, rayDirection);
+}
+
+void Cube::appendTo(SceneBuilder& builder) const {
+    builder.addCube(min, max, material);
+}
+
+// Optimized Ray intersection method
+Intersect Cube::intersect(const glm::vec3& min, const glm::vec3& max,
+                          const glm::vec3& rayOrigin, const glm::vec3& rayDirection) {
     glm::vec3 invDir = 1.0f / rayDirection;
     glm::vec3 t0 = (min - rayOrigin) * invDir;
     glm::vec3 t1 = (max - rayOrigin) * invDir;
@@ -21,11 +31,12 @@ Intersect Cube::rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDir
     }
 
     glm::vec3 intersectPoint = rayOrigin + tNear * rayDirection;
-    return Intersect{intersectPoint, calculateNormal(intersectPoint), tNear};
+    glm::vec3 normal = calculateNormal(min, max, intersectPoint);
+    return Intersect{intersectPoint, normal, tNear};
 }
 
 // Optimized calculateNormal method
-glm::vec3 Cube::calculateNormal(const glm::vec3& intersectPoint) const {
+glm::vec3 Cube::calculateNormal(const glm::vec3& min, const glm::vec3& max, const glm::vec3& intersectPoint) {
     const float bias = 1e-4; // Small bias to handle numerical precision issues
     glm::vec3 normal = glm::vec3(0.0f);
 
@@ -37,4 +48,14 @@ glm::vec3 Cube::calculateNormal(const glm::vec3& intersectPoint) const {
     else if (std::fabs(intersectPoint.z - max.z) < bias) normal.z = 1.0f;
 
     return normal;
-}
\ No newline at end of file
+}
+
+// Projects the hit point onto the face plane; v grows downwards on side faces like image rows
+SurfaceUV Cube::calculateUV(const glm::vec3& min, const glm::vec3& max, const Intersect& hit) {
+    float scale = 1.0f / (max.x - min.x);
+    glm::vec3 local = (hit.point - min) * scale;
+
+    if (hit.normal.x != 0.0f) return SurfaceUV{glm::vec2(local.z, 1.0f - local.y), scale};
+    if (hit.normal.y != 0.0f) return SurfaceUV{glm::vec2(local.x, local.z), scale};
+    return SurfaceUV{glm::vec2(local.x, 1.0f - local.y), scale};
+}
@@ -9,11 +9,19 @@ class Cube : public Object {
 public:
     Cube(const glm::vec3& min, const glm::vec3& max, const Material& mat);
     Intersect rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const override;
+    void appendTo(SceneBuilder& builder) const override;
+
+    // Ray/box test shared with the flat scene records
+    static Intersect intersect(const glm::vec3& min, const glm::vec3& max,
+                               const glm::vec3& rayOrigin, const glm::vec3& rayDirection);
+
+    // Maps a hit on one of the faces to [0, 1] texture coordinates
+    static SurfaceUV calculateUV(const glm::vec3& min, const glm::vec3& max, const Intersect& hit);
 
 private:
     glm::vec3 min;
     glm::vec3 max;
 
     // Declaration of calculateNormal method
-    glm::vec3 calculateNormal(const glm::vec3& point) const;
+    static glm::vec3 calculateNormal(const glm::vec3& min, const glm::vec3& max, const glm::vec3& point);
 };
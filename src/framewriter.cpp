@@ -0,0 +1,122 @@
+#include "framewriter.h"
+#include <SDL_image.h>
+#include <filesystem>
+#include <stdexcept>
+
+FrameWriter::FrameWriter(const std::string& output, int width, int height, size_t queueCapacity)
+    : output(output), width(width), height(height), toStdout(output == "-") {
+    if (!toStdout) {
+        std::filesystem::create_directories(output);
+    }
+
+    // Allocate the whole pool up front so the render loop never touches the allocator
+    freeFrames.resize(std::max<size_t>(1, queueCapacity));
+    for (Frame& frame : freeFrames) {
+        frame.pixels.resize(3 * width * height);
+    }
+
+    worker = std::thread(&FrameWriter::run, this);
+}
+
+FrameWriter::~FrameWriter() {
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closing = true;
+        }
+        frameReady.notify_one();
+        worker.join();
+    }
+}
+
+Frame FrameWriter::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    bufferFree.wait(lock, [this] { return !freeFrames.empty() || error; });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    Frame frame = std::move(freeFrames.back());
+    freeFrames.pop_back();
+    return frame;
+}
+
+void FrameWriter::submit(Frame&& frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(frame));
+    }
+    frameReady.notify_one();
+}
+
+void FrameWriter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    frameReady.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void FrameWriter::run() {
+    while (true) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameReady.wait(lock, [this] { return !pending.empty() || closing; });
+            if (pending.empty()) {
+                return;
+            }
+            frame = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        try {
+            write(frame);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+            pending.clear();
+            bufferFree.notify_all();
+            return;
+        }
+
+        // Hand the buffer back to the tracer
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeFrames.push_back(std::move(frame));
+        }
+        bufferFree.notify_one();
+    }
+}
+
+void FrameWriter::write(const Frame& frame) {
+    if (toStdout) {
+        size_t size = frame.pixels.size();
+        if (std::fwrite(frame.pixels.data(), 1, size, stdout) != size) {
+            throw std::runtime_error("Failed to write frame " + std::to_string(frame.index) + " to stdout");
+        }
+        std::fflush(stdout);
+        return;
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05d.png", frame.index);
+    std::string path = (std::filesystem::path(output) / name).string();
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        const_cast<Uint8*>(frame.pixels.data()), width, height, 24, 3 * width, SDL_PIXELFORMAT_RGB24);
+    if (!surface) {
+        throw std::runtime_error("Failed to wrap frame " + std::to_string(frame.index) + ": " + std::string(SDL_GetError()));
+    }
+    int result = IMG_SavePNG(surface, path.c_str());
+    SDL_FreeSurface(surface);
+    if (result != 0) {
+        throw std::runtime_error("Failed to write " + path + ": " + std::string(IMG_GetError()));
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A finished RGB24 frame travelling from the tracer to the writer thread.
+struct Frame {
+    int index = 0;
+    std::vector<Uint8> pixels;
+};
+
+// Encodes and writes finished frames on a dedicated I/O thread.
+// Frame buffers come from a fixed pool, so at most `queueCapacity` frames are ever in memory
+// and the tracer only stalls when the writer falls that many frames behind.
+class FrameWriter {
+public:
+    // `output` is either a directory for a numbered PNG sequence (frame_00000.png, ...)
+    // or "-" to stream raw RGB24 frames to stdout.
+    FrameWriter(const std::string& output, int width, int height, size_t queueCapacity);
+    ~FrameWriter();
+
+    Frame acquire();
+    void submit(Frame&& frame);
+
+    // Drains the queue, joins the writer thread and rethrows any write error.
+    void finish();
+
+private:
+    void run();
+    void write(const Frame& frame);
+
+    std::string output;
+    int width;
+    int height;
+    bool toStdout;
+
+    std::mutex mutex;
+    std::condition_variable frameReady;
+    std::condition_variable bufferFree;
+    std::deque<Frame> pending;
+    std::vector<Frame> freeFrames;
+    bool closing = false;
+    std::exception_ptr error;
+    std::thread worker;
+};
@@ -31,4 +31,10 @@ struct Intersect {
 
     // Constructor que acepta un argumento booleano para isIntersecting
     Intersect(bool intersect) : point(glm::vec3(0.0f)), normal(glm::vec3(0.0f)), distance(0.0f), isIntersecting(intersect) {}
+};
+
+// Coordenadas de textura del impacto sombreado; solo se calculan para el impacto más cercano
+struct SurfaceUV {
+    glm::vec2 uv;
+    float scale;    // Unidades uv por unidad de mundo, para el footprint del ray cone
 };
\ No newline at end of file
@@ -3,7 +3,10 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 #include <vector>
+#include <string>
 #include <cstdlib>
+#include <chrono>
+#include <cmath>
 #include "skybox.h"
 #include "light.h"
 #include "color.h"
@@ -11,107 +14,155 @@
 #include "sphere.h"
 #include "cube.h"
 #include "camera.h"
+#include "camerapath.h"
+#include "framewriter.h"
+#include "texture.h"
+#include "scene.h"
+#include "scenecache.h"
 
 #define SCREEN_WIDTH 600
 #define SCREEN_HEIGHT 400
 #define FOV glm::radians(90.0f)  // Field of view is 90 degrees
 #define ASPECT_RATIO (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT
 #define BIAS 0.01f
-#define MAX_RECURSION_DEPTH 2
+constexpr int MAX_RECURSION_DEPTH = 2;
+constexpr int MAX_QUEUE_FRAMES = 64;  // Each queued frame holds a full RGB24 buffer
+#define SKYBOX_FILE "./textures/skybox.jpg"
+#define SCENE_CACHE_FILE "./scene.cache"
+// Part of the scene cache hash. Bump it whenever the scene-building loops in main() change shape;
+// their numeric inputs are hashed directly.
+constexpr int SCENE_GENERATION_REVISION = 1;
 
 SDL_Renderer* renderer = nullptr;
 Light light(glm::vec3(0.0f, 14.0f, -60.0f), 1.5f, Color(255, 255, 255));
 Camera camera(glm::vec3(-2.0f, 14.0f, -30.0f), glm::vec3(0.0f, 0.0f, 0.0f), 10.0f);
-Skybox skybox("./textures/skybox.jpg");
-
-float castShadow(const glm::vec3& shadowOrig, const glm::vec3& lightDir, 
-                 const std::vector<Object*>& objects, Object* hitObject) {
-    for (auto& obj : objects) {
-        if (obj != hitObject) {
-            // Add a small bias to the origin to prevent shadow acne
-            glm::vec3 biasedOrigin = shadowOrig + BIAS * lightDir;
-
-            Intersect shadowIntersect = obj->rayIntersect(biasedOrigin, lightDir);
-            if (shadowIntersect.isIntersecting && shadowIntersect.distance > 0) {
-                // Calculate the shadow intensity based on the distance to the intersecting object
-                // The intensity decreases as the object is closer to the shadow origin
-                float lightDistance = glm::length(light.position - shadowOrig);
-                float shadowFactor = shadowIntersect.distance / lightDistance;
-                shadowFactor = glm::clamp(shadowFactor, 0.0f, 1.0f); // Clamp between 0 and 1
-
-                // Calculate final shadow intensity
-                const float shadowIntensity = 1.0f - shadowFactor;
-                return shadowIntensity;
-            }
-        }
-    }
-
-    return 1.0f; // No shadow
-}
-
-Color computeShading(const glm::vec3& orig, const glm::vec3& dir, const Intersect& intersect, 
-                     Object* hitObject, const std::vector<Object*>& objects, const short recursion);
-
-Color castRay(const glm::vec3& orig, const glm::vec3& dir, 
-              const std::vector<Object*>& objects, const short recursion = 0) {
-    Intersect closestIntersect;
-    Object* hitObject = nullptr;
-    float closestDistance = std::numeric_limits<float>::infinity();
-
-    // Find the closest intersecting object
-    for (auto& obj : objects) {
-        Intersect intersect = obj->rayIntersect(orig, dir);
-        if (intersect.isIntersecting && intersect.distance < closestDistance) {
-            closestDistance = intersect.distance;
-            closestIntersect = intersect;
-            hitObject = obj;
-        }
-    }
-
-    // Return sky color if no intersection or max recursion depth reached
-    if (!closestIntersect.isIntersecting || recursion >= MAX_RECURSION_DEPTH) {
-        return skybox.getColor(dir);
-    }
-
-    // Compute lighting and shading
-    return computeShading(orig, dir, closestIntersect, hitObject, objects, recursion);
-}
-
-Color computeShading(const glm::vec3& orig, const glm::vec3& dir, const Intersect& intersect, 
-                     Object* hitObject, const std::vector<Object*>& objects, const short recursion) {
-    const Material& mat = hitObject->getMaterial();
+Skybox skybox;
+TextureCache textureCache;
+
+// Ray cone used for texture level selection: its width at the ray origin and how fast it widens with distance
+struct RayCone {
+    float width;
+    float spread;
+};
+
+template <int Depth, bool Generic>
+Color castRay(const glm::vec3& orig, const glm::vec3& dir,
+              const Scene& scene, const RayCone& cone);
+
+// Shading kernel specialized on a material's feature flags and on the recursion depth.
+// Features the material lacks are compiled out, so opaque blocks never see the
+// reflection/refraction branches and the deepest level never recurses.
+// Generic kernels are only used by the benchmark as the unspecialized baseline.
+template <Uint8 Features, int Depth, bool Generic = false>
+Color computeShading(const glm::vec3& orig, const glm::vec3& dir, const Intersect& intersect,
+                     size_t hitIndex, const Scene& scene, const RayCone& cone) {
+    constexpr bool reflective = (Features & Reflective) != 0;
+    constexpr bool refractive = (Features & Refractive) != 0;
+    constexpr bool emissive = (Features & Emissive) != 0;
+
+    const Material& mat = scene.materialOf(hitIndex);
     glm::vec3 lightDir = glm::normalize(light.position - intersect.point);
     glm::vec3 viewDir = glm::normalize(orig - intersect.point);
-    float shadowIntensity = castShadow(intersect.point + BIAS * intersect.normal, lightDir, objects, hitObject);
-    float intensity = shadowIntensity * light.intensity;
 
-    // Calculate diffuse and specular components
+    // Calculate diffuse and specular components; pow is skipped when the highlight faces away
     float diffIntensity = std::max(0.0f, glm::dot(intersect.normal, lightDir));
     glm::vec3 reflectDir = glm::reflect(-lightDir, intersect.normal);
-    float specIntensity = std::pow(std::max(0.0f, glm::dot(viewDir, reflectDir)), mat.specularCoefficient);
+    float specDot = glm::dot(viewDir, reflectDir);
+    float specIntensity = specDot > 0.0f ? std::pow(specDot, mat.specularCoefficient) : 0.0f;
+
+    // Sample the block texture at the mip level matching the ray cone footprint.
+    // The footprint grows at grazing angles, where one pixel covers more of the face.
+    float coneWidth = cone.width + cone.spread * intersect.distance;
+    Color surface = mat.diffuse;
+    int texture = mat.textures.forNormal(intersect.normal);
+    if (texture >= 0) {
+        float cosTheta = std::max(std::abs(glm::dot(dir, intersect.normal)), 0.1f);
+        SurfaceUV hitUV = scene.surfaceUV(hitIndex, intersect);
+        surface = textureCache.sample(texture, hitUV.uv, coneWidth * hitUV.scale / cosTheta);
+    }
 
-    Color diffuse = diffIntensity * mat.albedo * mat.diffuse;
+    Color diffuse = diffIntensity * mat.albedo * surface;
     Color specular = specIntensity * mat.specularAlbedo * light.color;
 
-    // Compute reflected and refracted components, if applicable
-    Color reflected, refracted;
-    if (mat.reflectivity > 0) {
-        reflected = mat.reflectivity * castRay(intersect.point + BIAS * intersect.normal, reflectDir, objects, recursion + 1);
-    }
-    if (mat.transparency > 0) {
-        glm::vec3 refractDir = glm::refract(dir, intersect.normal, mat.refractionIndex);
-        refracted = mat.transparency * castRay(intersect.point - BIAS * intersect.normal, refractDir, objects, recursion + 1);
+    Color result;
+    if constexpr (!reflective && !refractive) {
+        result = diffuse + specular;
+    } else {
+        // Compute reflected and refracted components. The runtime checks only matter for the
+        // generic AllFeatures kernel, which also serves materials without these features.
+        Color reflected, refracted;
+        RayCone secondary{coneWidth, cone.spread};
+        if constexpr (reflective) {
+            if (mat.reflectivity > 0) {
+                reflected = mat.reflectivity * castRay<Depth + 1, Generic>(intersect.point + BIAS * intersect.normal, reflectDir, scene, secondary);
+            }
+        }
+        if constexpr (refractive) {
+            if (mat.transparency > 0) {
+                glm::vec3 refractDir = glm::refract(dir, intersect.normal, mat.refractionIndex);
+                refracted = mat.transparency * castRay<Depth + 1, Generic>(intersect.point - BIAS * intersect.normal, refractDir, scene, secondary);
+            }
+        }
+
+        result = (1 - mat.reflectivity - mat.transparency) * (diffuse + specular) + reflected + refracted;
     }
 
-    return (1 - mat.reflectivity - mat.transparency) * (diffuse + specular) + reflected + refracted;
+    if constexpr (emissive) {
+        result = result + mat.emission * surface;
+    }
+    return result;
 }
 
-void pixel(glm::vec2 position, Color color) {
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-    SDL_RenderDrawPoint(renderer, position.x, position.y);
+using ShadingKernel = Color (*)(const glm::vec3&, const glm::vec3&, const Intersect&,
+                                size_t, const Scene&, const RayCone&);
+
+// One kernel per feature combination, indexed by Material::kernelId
+template <int Depth>
+constexpr ShadingKernel shadingKernels[AllFeatures + 1] = {
+    computeShading<0, Depth>, computeShading<1, Depth>, computeShading<2, Depth>, computeShading<3, Depth>,
+    computeShading<4, Depth>, computeShading<5, Depth>, computeShading<6, Depth>, computeShading<7, Depth>
+};
+
+// Generic selects the AllFeatures kernel for every hit instead of dispatching on kernelId
+template <int Depth, bool Generic>
+Color castRay(const glm::vec3& orig, const glm::vec3& dir,
+              const Scene& scene, const RayCone& cone) {
+    // Past the maximum depth only the sky is visible
+    if constexpr (Depth >= MAX_RECURSION_DEPTH) {
+        return skybox.getColor(dir);
+    } else {
+        Intersect closestIntersect;
+        size_t hitIndex = 0;
+        float closestDistance = std::numeric_limits<float>::infinity();
+
+        // Find the closest intersecting primitive
+        for (size_t i = 0; i < scene.primitiveCount(); ++i) {
+            Intersect intersect = scene.intersect(i, orig, dir);
+            if (intersect.isIntersecting && intersect.distance < closestDistance) {
+                closestDistance = intersect.distance;
+                closestIntersect = intersect;
+                hitIndex = i;
+            }
+        }
+
+        // Return sky color if no intersection
+        if (!closestIntersect.isIntersecting) {
+            return skybox.getColor(dir);
+        }
+
+        // Compute lighting and shading with the kernel for this material
+        if constexpr (Generic) {
+            return computeShading<AllFeatures, Depth, true>(orig, dir, closestIntersect, hitIndex, scene, cone);
+        } else {
+            ShadingKernel kernel = shadingKernels<Depth>[scene.materialOf(hitIndex).kernelId];
+            return kernel(orig, dir, closestIntersect, hitIndex, scene, cone);
+        }
+    }
 }
 
-void render(std::vector<Object*>& objects) {
+// Traces the current camera view into an RGB24 buffer of SCREEN_WIDTH * SCREEN_HEIGHT pixels.
+template <bool Generic = false>
+void render(const Scene& scene, Uint8* pixels) {
     // Camera orientation vectors
     glm::vec3 dir = glm::normalize(camera.target - camera.position);
     glm::vec3 right = glm::normalize(glm::cross(dir, glm::vec3(0, 1, 0)));
@@ -122,6 +173,9 @@ void render(std::vector<Object*>& objects) {
     float heightInv = 1.0f / SCREEN_HEIGHT;
     float aspectRatio = ASPECT_RATIO;
 
+    // Primary rays start as a point and widen by the angle one pixel subtends
+    RayCone primary{0.0f, std::atan(2.0f * heightInv)};
+
     for (int y = 0; y < SCREEN_HEIGHT; ++y) {
         for (int x = 0; x < SCREEN_WIDTH; ++x) {
             // Convert pixel position to normalized device coordinates (NDC)
@@ -131,32 +185,119 @@ void render(std::vector<Object*>& objects) {
             // Adjust for aspect ratio and compute ray direction
             glm::vec3 rayDir = glm::normalize(dir + right * ndcX * aspectRatio + up * ndcY);
 
-            // Cast the ray and draw the pixel
-            pixel(glm::vec2(x, y), castRay(camera.position, rayDir, objects));
+            // Cast the ray and store the pixel
+            Color color = castRay<0, Generic>(camera.position, rayDir, scene, primary);
+            Uint8* out = pixels + 3 * (y * SCREEN_WIDTH + x);
+            out[0] = color.r;
+            out[1] = color.g;
+            out[2] = color.b;
         }
     }
 }
 
+// Renders every frame of a keyframed camera path without opening a window.
+// Tracing stays on this thread while the FrameWriter encodes and writes finished frames.
+int renderAnimation(const Scene& scene, const std::string& pathFile, float fps,
+                    const std::string& output, size_t queueCapacity) {
+    CameraPath path(pathFile);
+    int frameTotal = static_cast<int>(path.duration() * fps) + 1;
 
-int main(int argc, char* args[]) {
-    SDL_Init(SDL_INIT_VIDEO);
+    // stdout may carry the video stream, so progress goes to stderr
+    std::cerr << "Rendering " << frameTotal << " frames at " << fps << " fps to "
+              << (output == "-" ? "stdout" : output) << std::endl;
 
-    SDL_Window* window = SDL_CreateWindow(
-        "Proyecto 3: Raytracing",
-        SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-        SCREEN_WIDTH, SCREEN_HEIGHT,
-        SDL_WINDOW_OPENGL
-    );
+    auto start = std::chrono::steady_clock::now();
+    FrameWriter writer(output, SCREEN_WIDTH, SCREEN_HEIGHT, queueCapacity);
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    for (int i = 0; i < frameTotal; ++i) {
+        CameraKeyframe pose = path.sample(i / fps);
+        camera.position = pose.position;
+        camera.target = pose.target;
 
-    bool isRunning = true;
-    SDL_Event event;
-    float rotateAngle = 0.0f;
+        Frame frame = writer.acquire();
+        frame.index = i;
+        render(scene, frame.pixels.data());
+        writer.submit(std::move(frame));
 
-    unsigned int lastTime = SDL_GetTicks();
-    unsigned int currentTime;
-    float dT;
+        std::cerr << "\rFrame " << (i + 1) << "/" << frameTotal << std::flush;
+    }
+    writer.finish();
+
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "\nDone in " << seconds << "s (" << frameTotal / seconds << " frames/s)" << std::endl;
+#ifdef TEXTURE_CACHE_STATS
+    const TextureStats& stats = textureCache.stats();
+    std::cerr << "Texel fetches: " << stats.texelFetches << ", simulated texture cache misses: " << stats.cacheMisses << std::endl;
+#endif
+    return 0;
+}
+
+template <bool Generic>
+float millisecondsPerFrame(const Scene& scene, int frames, Uint8* pixels) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        render<Generic>(scene, pixels);
+    }
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+// Times the default view with the specialized kernels against the generic AllFeatures kernel.
+int runShadingBenchmark(const Scene& scene, int frames) {
+    std::vector<Uint8> framebuffer(3 * SCREEN_WIDTH * SCREEN_HEIGHT);
+
+    int opaqueObjects = 0;
+    for (size_t i = 0; i < scene.primitiveCount(); ++i) {
+        if (scene.materialOf(i).kernelId == Opaque) opaqueObjects++;
+    }
+    std::cout << "Opaque objects: " << opaqueObjects << " of " << scene.primitiveCount() << std::endl;
+
+    render(scene, framebuffer.data());  // Warm up caches and textures
+
+    float generic = millisecondsPerFrame<true>(scene, frames, framebuffer.data());
+    float specialized = millisecondsPerFrame<false>(scene, frames, framebuffer.data());
+
+    std::cout << "Generic kernel:      " << generic << " ms/frame" << std::endl;
+    std::cout << "Specialized kernels: " << specialized << " ms/frame" << std::endl;
+    std::cout << "Speedup: " << generic / specialized << "x" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* args[]) {
+    auto startupBegin = std::chrono::steady_clock::now();
+
+    // Batch mode: SR --path <file> [--fps <n>] [--out <dir>|-] [--queue <frames>]
+    // Benchmark mode: SR --bench <frames>
+    std::string pathFile;
+    int benchFrames = 0;
+    std::string output = "frames";
+    float fps = 30.0f;
+    int queueCapacity = 4;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = args[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--path" && hasValue) pathFile = args[++i];
+            else if (arg == "--out" && hasValue) output = args[++i];
+            else if (arg == "--fps" && hasValue) fps = std::stof(args[++i]);
+            else if (arg == "--queue" && hasValue) queueCapacity = std::stoi(args[++i]);
+            else if (arg == "--bench" && hasValue) benchFrames = std::max(1, std::stoi(args[++i]));
+            else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid value for " << arg << ": " << args[i] << std::endl;
+            return 1;
+        }
+    }
+    if (!std::isfinite(fps) || fps <= 0.0f) {
+        std::cerr << "--fps must be a positive number" << std::endl;
+        return 1;
+    }
+    if (queueCapacity < 1 || queueCapacity > MAX_QUEUE_FRAMES) {
+        std::cerr << "--queue must be between 1 and " << MAX_QUEUE_FRAMES << " frames" << std::endl;
+        return 1;
+    }
 
     // Stone for the mountain
     Material stone(
@@ -210,97 +351,223 @@ int main(int argc, char* args[]) {
         0.1f
     );
 
-    std::vector<Object*> objects;
+    // Block textures; only the ids are assigned here. The mip chains come from the scene cache or
+    // are decoded on a cold start, where missing files fall back to generated noise in the block color
+    stone.textures = BlockFaces(textureCache.add("./textures/blocks/stone.png", stone.diffuse));
+    sandBlock.textures = BlockFaces(textureCache.add("./textures/blocks/sand.png", sandBlock.diffuse));
+    leavesBlock.textures = BlockFaces(textureCache.add("./textures/blocks/leaves.png", leavesBlock.diffuse));
+    int logTop = textureCache.add("./textures/blocks/log_top.png", woodBlock.diffuse);
+    int logSide = textureCache.add("./textures/blocks/log.png", woodBlock.diffuse);
+    woodBlock.textures = BlockFaces(logTop, logSide, logTop);
 
+    // Scene generation parameters. Every number the rebuild below uses lives here so it is hashed.
     // Define the size of each cube (Minecraft style)
     float cubeSize = 2.0f;
-
-    // Larger Mountain Landscape
+    int gridStep = 2;        // Distance between neighbouring blocks
     int landscapeSize = 10;  // Increase landscape size
-    for (int x = -landscapeSize; x <= landscapeSize; x += 2) {
-        for (int z = -landscapeSize; z <= landscapeSize; z += 2) {
-            float height = std::max(0.0f, 8.0f - glm::length(glm::vec2(x, z)));  // Adjusted hill shape
-            for (int y = 0; y < height; y += 2) {
-                objects.push_back(new Cube(
-                    glm::vec3(x, y, z),
-                    glm::vec3(x + cubeSize, y + cubeSize, z + cubeSize),
-                    stone
-                ));
-            }
-        }
-    }
-
-    // Base Layer (Dirt or Sand)
-    for (int x = -landscapeSize; x <= landscapeSize; x += 2) {
-        for (int z = -landscapeSize; z <= landscapeSize; z += 2) {
-            objects.push_back(new Cube(
-                glm::vec3(x, -2.0f, z),
-                glm::vec3(x + cubeSize, 0.0f, z + cubeSize),
-                sandBlock  // or sandBlock
-            ));
-        }
-    }
+    float hillHeight = 8.0f; // Height at the centre; the hill drops one unit per unit of distance
+    float sandBottom = -2.0f;
+    float sandTop = 0.0f;
 
     // Asumimos que la montaña tiene una altura máxima de 8 y empieza a disminuir desde ahí
     int alturaMaxima = 7;
     int xCascada = 0;  // Coordenada X donde comienza la cascada
     int zCascada = -4; // Coordenada Z donde comienza la cascada
-
-    // Construir la cascada
-    for (int y = alturaMaxima; y >= 0; y -= 2) {
-        // Colocar un cubo de agua en cada paso hacia abajo
-        objects.push_back(new Cube(
-            glm::vec3(xCascada, y, zCascada),
-            glm::vec3(xCascada + cubeSize, y + cubeSize, zCascada + cubeSize),
-            waterBlock
-        ));
-
-        // Ajustar la posición Z para el siguiente cubo, si es necesario
-        zCascada -= 2;
-    }
-
     int yBaseCascada = -2; // La altura en la que termina la cascada
-    for (int y = yBaseCascada+2; y >= yBaseCascada - 10; y -= 2) {
-        objects.push_back(new Cube(
-            glm::vec3(xCascada, y, zCascada),
-            glm::vec3(xCascada + cubeSize, y + cubeSize, zCascada + cubeSize),
-            waterBlock
-        ));
-    }
+    int profundidadCola = 10; // Cuánto baja la cola de la cascada por debajo de yBaseCascada
 
     // Trees spread out across the landscape
     std::vector<glm::vec2> treePositions = {{-8, 8}, {10, -10}, {-10, 10}, {8, -8}, {-6, -6}};
-    for (auto& pos : treePositions) {
-        // Tree trunk
-        for (int y = 0; y <= 4; y += 2) {
+    int trunkHeight = 4;      // Height of the topmost trunk block
+    int leavesRadius = 2;     // Leaves reach this far from the trunk
+    float leavesBottom = 6.0f;
+    float leavesTop = 8.0f;
+    glm::vec3 sphereCenter(-12.0f, 8.0f, -10.0f);
+    float sphereRadius = 2.0f;
+
+    // The compiled scene is mapped from the cache when its inputs are unchanged and rebuilt otherwise.
+    // The hash covers the generation revision, the materials (including the block texture ids they
+    // hold), the texture files behind those ids, the generation parameters above and the skybox image.
+    // Image files are keyed on name, size and modification time, so a warm start reads none of them.
+    SceneHash sceneHash;
+    sceneHash.add(SCENE_GENERATION_REVISION);
+    for (const Material* material : {&stone, &waterBlock, &leavesBlock, &woodBlock, &sandBlock, &glass}) {
+        sceneHash.add(*material);
+    }
+    for (const std::string& textureFile : textureCache.files()) {
+        sceneHash.addFile(textureFile);
+    }
+    sceneHash.add(cubeSize);
+    sceneHash.add(gridStep);
+    sceneHash.add(landscapeSize);
+    sceneHash.add(hillHeight);
+    sceneHash.add(sandBottom);
+    sceneHash.add(sandTop);
+    sceneHash.add(alturaMaxima);
+    sceneHash.add(xCascada);
+    sceneHash.add(zCascada);
+    sceneHash.add(yBaseCascada);
+    sceneHash.add(profundidadCola);
+    sceneHash.add(static_cast<int>(treePositions.size()));
+    for (const glm::vec2& pos : treePositions) {
+        sceneHash.add(pos);
+    }
+    sceneHash.add(trunkHeight);
+    sceneHash.add(leavesRadius);
+    sceneHash.add(leavesBottom);
+    sceneHash.add(leavesTop);
+    sceneHash.add(sphereCenter);
+    sceneHash.add(sphereRadius);
+    sceneHash.addFile(SKYBOX_FILE);
+    uint64_t inputHash = sceneHash.value();
+    SceneCache sceneCache;
+    SceneBuilder builder;
+    Scene scene;
+    bool warmStart = sceneCache.map(SCENE_CACHE_FILE, inputHash);
+
+    if (warmStart) {
+        scene = sceneCache.scene();
+        textureCache.useTable(sceneCache.textures());
+        skybox.useTexels(sceneCache.skyboxTexels(), sceneCache.skyboxWidth(), sceneCache.skyboxHeight(),
+                         3 * sceneCache.skyboxWidth());
+    } else {
+        std::vector<Object*> objects;
+
+        // Larger Mountain Landscape
+        for (int x = -landscapeSize; x <= landscapeSize; x += gridStep) {
+            for (int z = -landscapeSize; z <= landscapeSize; z += gridStep) {
+                float height = std::max(0.0f, hillHeight - glm::length(glm::vec2(x, z)));  // Adjusted hill shape
+                for (int y = 0; y < height; y += gridStep) {
+                    objects.push_back(new Cube(
+                        glm::vec3(x, y, z),
+                        glm::vec3(x + cubeSize, y + cubeSize, z + cubeSize),
+                        stone
+                    ));
+                }
+            }
+        }
+
+        // Base Layer (Dirt or Sand)
+        for (int x = -landscapeSize; x <= landscapeSize; x += gridStep) {
+            for (int z = -landscapeSize; z <= landscapeSize; z += gridStep) {
+                objects.push_back(new Cube(
+                    glm::vec3(x, sandBottom, z),
+                    glm::vec3(x + cubeSize, sandTop, z + cubeSize),
+                    sandBlock  // or sandBlock
+                ));
+            }
+        }
+
+        // Construir la cascada
+        for (int y = alturaMaxima; y >= 0; y -= gridStep) {
+            // Colocar un cubo de agua en cada paso hacia abajo
             objects.push_back(new Cube(
-                glm::vec3(pos.x, y, pos.y),
-                glm::vec3(pos.x + cubeSize, y + cubeSize, pos.y + cubeSize),
-                woodBlock
+                glm::vec3(xCascada, y, zCascada),
+                glm::vec3(xCascada + cubeSize, y + cubeSize, zCascada + cubeSize),
+                waterBlock
             ));
+
+            // Ajustar la posición Z para el siguiente cubo, si es necesario
+            zCascada -= gridStep;
         }
-        // Tree leaves
-        for (int x = pos.x - 2; x <= pos.x + 2; x += 2) {
-            for (int z = pos.y - 2; z <= pos.y + 2; z += 2) {
-                if (x != pos.x || z != pos.y) {  // Avoid the center top of the trunk
-                    objects.push_back(new Cube(
-                        glm::vec3(x, 6.0f, z),
-                        glm::vec3(x + cubeSize, 8.0f, z + cubeSize),
-                        leavesBlock
-                    ));
+
+        for (int y = yBaseCascada + gridStep; y >= yBaseCascada - profundidadCola; y -= gridStep) {
+            objects.push_back(new Cube(
+                glm::vec3(xCascada, y, zCascada),
+                glm::vec3(xCascada + cubeSize, y + cubeSize, zCascada + cubeSize),
+                waterBlock
+            ));
+        }
+
+        // Trees spread out across the landscape
+        for (auto& pos : treePositions) {
+            // Tree trunk
+            for (int y = 0; y <= trunkHeight; y += gridStep) {
+                objects.push_back(new Cube(
+                    glm::vec3(pos.x, y, pos.y),
+                    glm::vec3(pos.x + cubeSize, y + cubeSize, pos.y + cubeSize),
+                    woodBlock
+                ));
+            }
+            // Tree leaves
+            for (int x = pos.x - leavesRadius; x <= pos.x + leavesRadius; x += gridStep) {
+                for (int z = pos.y - leavesRadius; z <= pos.y + leavesRadius; z += gridStep) {
+                    if (x != pos.x || z != pos.y) {  // Avoid the center top of the trunk
+                        objects.push_back(new Cube(
+                            glm::vec3(x, leavesBottom, z),
+                            glm::vec3(x + cubeSize, leavesTop, z + cubeSize),
+                            leavesBlock
+                        ));
+                    }
                 }
             }
         }
+
+        objects.push_back(
+            new Sphere(
+                sphereCenter,
+                sphereRadius,
+                glass
+            ));
+
+        for (Object* object : objects) {
+            object->appendTo(builder);
+            delete object;
+        }
+        textureCache.decode();
+        try {
+            skybox.loadTexture(SKYBOX_FILE);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        scene = builder.view();
+
+        try {
+            SceneCache::write(SCENE_CACHE_FILE, inputHash, scene, textureCache.table(), skybox);
+        } catch (const std::exception& e) {
+            std::cerr << "Scene cache not saved: " << e.what() << std::endl;
+        }
     }
 
-    objects.push_back(
-        new Sphere(
-            glm::vec3(-12.0f, 8.0f, -10.0f),
-            2.0f,
-            glass
-        ));
+    float startupMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+    std::cerr << (warmStart ? "Warm start (mapped " : "Cold start (rebuilt ") << SCENE_CACHE_FILE << "): "
+              << startupMs << " ms, " << scene.primitiveCount() << " primitives, "
+              << scene.materials.size() << " materials" << std::endl;
 
 
+    if (!pathFile.empty() || benchFrames > 0) {
+        // Bad path files and failed frame writes surface here as exceptions
+        try {
+            return benchFrames > 0 ? runShadingBenchmark(scene, benchFrames)
+                                   : renderAnimation(scene, pathFile, fps, output, queueCapacity);
+        } catch (const std::exception& e) {
+            std::cerr << "\n" << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    SDL_Init(SDL_INIT_VIDEO);
+
+    SDL_Window* window = SDL_CreateWindow(
+        "Proyecto 3: Raytracing",
+        SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+        SCREEN_WIDTH, SCREEN_HEIGHT,
+        SDL_WINDOW_OPENGL
+    );
+
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Texture* screen = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING,
+                                            SCREEN_WIDTH, SCREEN_HEIGHT);
+    std::vector<Uint8> framebuffer(3 * SCREEN_WIDTH * SCREEN_HEIGHT);
+
+    bool isRunning = true;
+    SDL_Event event;
+
+    unsigned int lastTime = SDL_GetTicks();
+    unsigned int currentTime;
+    float dT;
+
     int frameCount = 0;
     float elapsedTime = 0.0f;
 
@@ -345,11 +612,11 @@ int main(int argc, char* args[]) {
             }
         }
 
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
-
-        render(objects);
+        render(scene, framebuffer.data());
 
+        SDL_UpdateTexture(screen, nullptr, framebuffer.data(), 3 * SCREEN_WIDTH);
+        SDL_RenderClear(renderer);
+        SDL_RenderCopy(renderer, screen, nullptr, nullptr);
         SDL_RenderPresent(renderer);
 
         // Calculate the deltaTime
@@ -361,18 +628,21 @@ int main(int argc, char* args[]) {
         elapsedTime += dT;
         if (elapsedTime >= 1.0f) {
             float fps = static_cast<float>(frameCount) / elapsedTime;
+#ifdef TEXTURE_CACHE_STATS
+            const TextureStats& stats = textureCache.stats();
+            std::cout << "FPS: " << fps << " | texel fetches: " << stats.texelFetches
+                      << ", simulated texture cache misses: " << stats.cacheMisses << std::endl;
+            textureCache.resetStats();
+#else
             std::cout << "FPS: " << fps << std::endl;
+#endif
 
             frameCount = 0;
             elapsedTime = 0.0f;
         }
     }
 
-    for (Object* object : objects) {
-        delete object;
-    }
-    objects.clear();
-
+    SDL_DestroyTexture(screen);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -3,8 +3,19 @@
 #include <algorithm>
 #include <iostream>
 #include "color.h"
+#include "texture.h"
 #include <algorithm>
 
+// Capability flags of a material. The combination is the material's kernel id and selects
+// a shading kernel specialized for exactly those features.
+enum MaterialFeature : Uint8 {
+    Opaque = 0,
+    Reflective = 1 << 0,
+    Refractive = 1 << 1,
+    Emissive = 1 << 2,
+    AllFeatures = Reflective | Refractive | Emissive
+};
+
 struct Material {
     Color diffuse;
     float albedo;
@@ -13,14 +24,23 @@ struct Material {
     float reflectivity; // The reflectivity of the material
     float transparency; // The transparency of the material
     float refractionIndex;
+    float emission; // Light emitted by the surface, as a fraction of its color
+    BlockFaces textures; // Block texture ids per face; untextured faces use diffuse
+    Uint8 kernelId; // MaterialFeature flags, derived once from the coefficients above
 
-    Material(const Color& color, float albedo, float specularAlbedo, float specCoef, float reflectivity = 0, float transparency = 0, float refractionIndex = 0) 
+    Material(const Color& color, float albedo, float specularAlbedo, float specCoef, float reflectivity = 0, float transparency = 0, float refractionIndex = 0, float emission = 0) 
         : diffuse(color),
           albedo(albedo),
           specularAlbedo(specularAlbedo),
           specularCoefficient(specCoef),
           reflectivity(reflectivity),
           transparency(transparency),
-          refractionIndex(refractionIndex)
+          refractionIndex(refractionIndex),
+          emission(emission),
+          kernelId((reflectivity > 0 ? Reflective : Opaque) |
+                   (transparency > 0 ? Refractive : Opaque) |
+                   (emission > 0 ? Emissive : Opaque))
         {}
+
+    bool operator==(const Material& other) const = default;
 };
\ No newline at end of file
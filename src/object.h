@@ -4,12 +4,16 @@
 #include "intersect.h"
 #include "material.h"
 
+class SceneBuilder;
+
 class Object {
 public:
     explicit Object(const Material& mat) : material(mat) {}
     virtual ~Object() = default;
     
     virtual Intersect rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const = 0;
+    // Adds the flat record the tracer uses for this object
+    virtual void appendTo(SceneBuilder& builder) const = 0;
     const Material& getMaterial() const { return material; }
 
 protected:
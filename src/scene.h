@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include <glm/glm.hpp>
+#include "intersect.h"
+#include "material.h"
+#include "cube.h"
+#include "sphere.h"
+
+// Pointer-free primitive records. The tracer reads them directly, so they can live in a mapped cache file.
+struct CubeRecord {
+    glm::vec3 min;
+    glm::vec3 max;
+    uint32_t material;
+};
+
+struct SphereRecord {
+    glm::vec3 center;
+    float radius;
+    uint32_t material;
+};
+
+static_assert(std::is_trivially_copyable_v<Material>, "Material must be storable in the scene cache");
+static_assert(std::is_trivially_copyable_v<CubeRecord>, "CubeRecord must be storable in the scene cache");
+static_assert(std::is_trivially_copyable_v<SphereRecord>, "SphereRecord must be storable in the scene cache");
+
+// Compiled scene as seen by the tracer: a material table plus primitive records.
+// Primitives are numbered with cubes first and spheres after them.
+struct Scene {
+    std::span<const Material> materials;
+    std::span<const CubeRecord> cubes;
+    std::span<const SphereRecord> spheres;
+
+    size_t primitiveCount() const { return cubes.size() + spheres.size(); }
+
+    const Material& materialOf(size_t index) const {
+        if (index < cubes.size()) return materials[cubes[index].material];
+        return materials[spheres[index - cubes.size()].material];
+    }
+
+    Intersect intersect(size_t index, const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const {
+        if (index < cubes.size()) {
+            const CubeRecord& cube = cubes[index];
+            return Cube::intersect(cube.min, cube.max, rayOrigin, rayDirection);
+        }
+        const SphereRecord& sphere = spheres[index - cubes.size()];
+        return Sphere::intersect(sphere.center, sphere.radius, rayOrigin, rayDirection);
+    }
+
+    // Texture coordinates of a hit on the given primitive. Only the shaded hit pays for this.
+    SurfaceUV surfaceUV(size_t index, const Intersect& hit) const {
+        if (index < cubes.size()) {
+            return Cube::calculateUV(cubes[index].min, cubes[index].max, hit);
+        }
+        return Sphere::calculateUV(spheres[index - cubes.size()].radius, hit);
+    }
+};
+
+// Collects records from scene objects, sharing one table entry between identical materials.
+class SceneBuilder {
+public:
+    uint32_t addMaterial(const Material& material) {
+        for (size_t i = 0; i < materials.size(); ++i) {
+            if (materials[i] == material) return static_cast<uint32_t>(i);
+        }
+        materials.push_back(material);
+        return static_cast<uint32_t>(materials.size() - 1);
+    }
+
+    void addCube(const glm::vec3& min, const glm::vec3& max, const Material& material) {
+        cubes.push_back(CubeRecord{min, max, addMaterial(material)});
+    }
+
+    void addSphere(const glm::vec3& center, float radius, const Material& material) {
+        spheres.push_back(SphereRecord{center, radius, addMaterial(material)});
+    }
+
+    Scene view() const {
+        return Scene{materials, cubes, spheres};
+    }
+
+private:
+    std::vector<Material> materials;
+    std::vector<CubeRecord> cubes;
+    std::vector<SphereRecord> spheres;
+};
@@ -0,0 +1,281 @@
+#include "scenecache.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[8] = {'S', 'R', 'S', 'C', 'E', 'N', 'E', '\0'};
+const uint64_t SECTION_ALIGNMENT = 64;
+
+// Texture records are made of fixed-width fields, so their layout is pinned by VERSION alone
+static_assert(sizeof(TextureRecord) == 8 && sizeof(MipLevel) == 16 && sizeof(TexelTile) == 64,
+              "Bump SceneCache::VERSION when the texture record layout changes");
+
+// 64-bit FNV-1a
+uint64_t fnv1a(uint64_t hash, const void* bytes, size_t length) {
+    const unsigned char* p = static_cast<const unsigned char*>(bytes);
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t alignUp(uint64_t value) {
+    return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// Checks that a section lies inside the mapped file and is aligned for its element type
+template <typename T>
+bool sectionFits(const SceneCacheSection& section, size_t fileSize) {
+    return section.offset % alignof(T) == 0 &&
+           section.offset <= fileSize &&
+           section.count <= (fileSize - section.offset) / sizeof(T);
+}
+
+// Writes each record through a zeroed buffer, copying only the listed members,
+// so padding bytes are always zero and cache files are reproducible
+template <typename T, typename... Members>
+void writeRecords(std::ostream& out, std::span<const T> records, Members T::*... members) {
+    for (const T& record : records) {
+        unsigned char bytes[sizeof(T)] = {};
+        auto copyMember = [&](auto T::*member) {
+            const auto& value = record.*member;
+            size_t offset = reinterpret_cast<const unsigned char*>(&value) - reinterpret_cast<const unsigned char*>(&record);
+            std::memcpy(bytes + offset, &value, sizeof(value));
+        };
+        (copyMember(members), ...);
+        out.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+    }
+}
+
+bool textureIdInRange(int id, size_t textureCount) {
+    return id == -1 || (id >= 0 && static_cast<size_t>(id) < textureCount);
+}
+
+// The tracer indexes the material, kernel, texture, level and tile tables with these values,
+// so a damaged file must not get past map() with any of them out of range
+bool recordsInRange(const Scene& scene, const TextureTable& textures) {
+    size_t textureCount = textures.textures.size();
+    for (const Material& material : scene.materials) {
+        if (material.kernelId > AllFeatures ||
+            !textureIdInRange(material.textures.top, textureCount) ||
+            !textureIdInRange(material.textures.side, textureCount) ||
+            !textureIdInRange(material.textures.bottom, textureCount)) return false;
+    }
+    for (const CubeRecord& cube : scene.cubes) {
+        if (cube.material >= scene.materials.size()) return false;
+    }
+    for (const SphereRecord& sphere : scene.spheres) {
+        if (sphere.material >= scene.materials.size()) return false;
+    }
+    for (const TextureRecord& texture : textures.textures) {
+        if (texture.levelCount == 0 || texture.firstLevel > textures.levels.size() ||
+            texture.levelCount > textures.levels.size() - texture.firstLevel) return false;
+    }
+    for (const MipLevel& level : textures.levels) {
+        if (level.width < 1 || level.height < 1 || level.tilesX != (level.width + 3) / 4) return false;
+        uint64_t tileCount = uint64_t(level.tilesX) * ((level.height + 3) / 4);
+        if (level.firstTile > textures.tiles.size() || tileCount > textures.tiles.size() - level.firstTile) return false;
+    }
+    return true;
+}
+
+template <typename T>
+std::span<const T> sectionSpan(const void* base, const SceneCacheSection& section) {
+    return {reinterpret_cast<const T*>(static_cast<const char*>(base) + section.offset), section.count};
+}
+
+}
+
+SceneCache::~SceneCache() {
+    unmap();
+}
+
+void SceneCache::unmap() {
+    if (data) {
+        munmap(data, size);
+    }
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    mapped = Scene();
+    mappedTextures = TextureTable();
+}
+
+SceneHash::SceneHash() : hash(0xcbf29ce484222325ULL) {
+    add(&SceneCache::VERSION, sizeof(SceneCache::VERSION));
+}
+
+void SceneHash::add(const void* bytes, size_t length) {
+    hash = fnv1a(hash, bytes, length);
+}
+
+void SceneHash::add(const std::string& value) {
+    uint64_t length = value.size();
+    add(&length, sizeof(length));
+    add(value.data(), value.size());
+}
+
+void SceneHash::add(const Material& material) {
+    Uint8 color[4] = {material.diffuse.r, material.diffuse.g, material.diffuse.b, material.diffuse.a};
+    add(color, sizeof(color));
+    add(material.albedo);
+    add(material.specularAlbedo);
+    add(material.specularCoefficient);
+    add(material.reflectivity);
+    add(material.transparency);
+    add(material.refractionIndex);
+    add(material.emission);
+    add(material.textures.top);
+    add(material.textures.side);
+    add(material.textures.bottom);
+    add(&material.kernelId, sizeof(material.kernelId));
+}
+
+void SceneHash::addFile(const std::string& file) {
+    add(file);
+
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(file, error);
+    if (error) {
+        return;
+    }
+    int64_t modified = std::filesystem::last_write_time(file, error).time_since_epoch().count();
+    add(&size, sizeof(size));
+    add(&modified, sizeof(modified));
+}
+
+bool SceneCache::map(const std::string& cacheFile, uint64_t inputHash) {
+    unmap();
+
+    int fd = open(cacheFile.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SceneCacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    size = static_cast<size_t>(info.st_size);
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        data = nullptr;
+        size = 0;
+        return false;
+    }
+
+    header = static_cast<const SceneCacheHeader*>(data);
+    bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header->version == VERSION &&
+                 header->materialSize == sizeof(Material) &&
+                 header->cubeSize == sizeof(CubeRecord) &&
+                 header->sphereSize == sizeof(SphereRecord) &&
+                 header->inputHash == inputHash &&
+                 sectionFits<Material>(header->materials, size) &&
+                 sectionFits<CubeRecord>(header->cubes, size) &&
+                 sectionFits<SphereRecord>(header->spheres, size) &&
+                 sectionFits<TextureRecord>(header->textures, size) &&
+                 sectionFits<MipLevel>(header->mipLevels, size) &&
+                 sectionFits<TexelTile>(header->tiles, size) &&
+                 sectionFits<Uint8>(header->skybox, size) &&
+                 header->skybox.count == uint64_t(3) * header->skyboxWidth * header->skyboxHeight;
+    if (!valid) {
+        unmap();
+        return false;
+    }
+
+    mapped.materials = sectionSpan<Material>(data, header->materials);
+    mapped.cubes = sectionSpan<CubeRecord>(data, header->cubes);
+    mapped.spheres = sectionSpan<SphereRecord>(data, header->spheres);
+    mappedTextures.textures = sectionSpan<TextureRecord>(data, header->textures);
+    mappedTextures.levels = sectionSpan<MipLevel>(data, header->mipLevels);
+    mappedTextures.tiles = sectionSpan<TexelTile>(data, header->tiles);
+    if (!recordsInRange(mapped, mappedTextures)) {
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+const Uint8* SceneCache::skyboxTexels() const {
+    return static_cast<const Uint8*>(data) + header->skybox.offset;
+}
+
+void SceneCache::write(const std::string& cacheFile, uint64_t inputHash, const Scene& scene,
+                       const TextureTable& textures, const Skybox& skybox) {
+    SceneCacheHeader fileHeader{};
+    std::memcpy(fileHeader.magic, MAGIC, sizeof(MAGIC));
+    fileHeader.version = VERSION;
+    fileHeader.materialSize = sizeof(Material);
+    fileHeader.cubeSize = sizeof(CubeRecord);
+    fileHeader.sphereSize = sizeof(SphereRecord);
+    fileHeader.inputHash = inputHash;
+    fileHeader.skyboxWidth = skybox.width();
+    fileHeader.skyboxHeight = skybox.height();
+
+    // Lay the sections out back to back, each starting on a 64-byte boundary
+    uint64_t offset = alignUp(sizeof(SceneCacheHeader));
+    auto place = [&offset](SceneCacheSection& section, uint64_t count, uint64_t elementSize) {
+        section = SceneCacheSection{offset, count};
+        offset = alignUp(offset + count * elementSize);
+    };
+    place(fileHeader.materials, scene.materials.size(), sizeof(Material));
+    place(fileHeader.cubes, scene.cubes.size(), sizeof(CubeRecord));
+    place(fileHeader.spheres, scene.spheres.size(), sizeof(SphereRecord));
+    place(fileHeader.textures, textures.textures.size(), sizeof(TextureRecord));
+    place(fileHeader.mipLevels, textures.levels.size(), sizeof(MipLevel));
+    place(fileHeader.tiles, textures.tiles.size(), sizeof(TexelTile));
+    place(fileHeader.skybox, uint64_t(3) * skybox.width() * skybox.height(), 1);
+
+    std::string tempFile = cacheFile + ".tmp";
+    std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create scene cache: " + tempFile);
+    }
+
+    // Zero-fills the alignment gap before a section
+    auto padTo = [&out](uint64_t position) {
+        while (static_cast<uint64_t>(out.tellp()) < position) out.put('\0');
+    };
+    out.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+
+    padTo(fileHeader.materials.offset);
+    writeRecords(out, scene.materials,
+                 &Material::diffuse, &Material::albedo, &Material::specularAlbedo, &Material::specularCoefficient,
+                 &Material::reflectivity, &Material::transparency, &Material::refractionIndex, &Material::emission,
+                 &Material::textures, &Material::kernelId);
+    padTo(fileHeader.cubes.offset);
+    writeRecords(out, scene.cubes, &CubeRecord::min, &CubeRecord::max, &CubeRecord::material);
+    padTo(fileHeader.spheres.offset);
+    writeRecords(out, scene.spheres, &SphereRecord::center, &SphereRecord::radius, &SphereRecord::material);
+    padTo(fileHeader.textures.offset);
+    writeRecords(out, textures.textures, &TextureRecord::firstLevel, &TextureRecord::levelCount);
+    padTo(fileHeader.mipLevels.offset);
+    writeRecords(out, textures.levels, &MipLevel::width, &MipLevel::height, &MipLevel::tilesX, &MipLevel::firstTile);
+    padTo(fileHeader.tiles.offset);
+    writeRecords(out, textures.tiles, &TexelTile::texels);
+
+    // Skybox rows are stored without the surface's row padding
+    padTo(fileHeader.skybox.offset);
+    for (int y = 0; y < skybox.height(); ++y) {
+        out.write(reinterpret_cast<const char*>(skybox.texels() + y * skybox.pitch()), 3 * skybox.width());
+    }
+
+    out.close();
+    if (!out || std::rename(tempFile.c_str(), cacheFile.c_str()) != 0) {
+        std::remove(tempFile.c_str());
+        throw std::runtime_error("Failed to write scene cache: " + cacheFile);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "scene.h"
+#include "skybox.h"
+#include "texture.h"
+
+// Byte range of one section, relative to the start of the cache file so the file is relocatable
+struct SceneCacheSection {
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct SceneCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t materialSize;
+    uint32_t cubeSize;
+    uint32_t sphereSize;
+    uint64_t inputHash;
+    SceneCacheSection materials;
+    SceneCacheSection cubes;
+    SceneCacheSection spheres;
+    SceneCacheSection textures;
+    SceneCacheSection mipLevels;
+    SceneCacheSection tiles;
+    SceneCacheSection skybox;     // Tightly packed RGB24 rows
+    uint32_t skyboxWidth;
+    uint32_t skyboxHeight;
+};
+
+// Incremental 64-bit FNV-1a hash of everything the compiled scene is built from.
+// A cache file is only used when its stored hash matches.
+class SceneHash {
+public:
+    SceneHash();
+
+    void add(const void* bytes, size_t length);
+    void add(int value) { add(&value, sizeof(value)); }
+    void add(float value) { add(&value, sizeof(value)); }
+    void add(const glm::vec2& value) { add(value.x); add(value.y); }
+    void add(const glm::vec3& value) { add(value.x); add(value.y); add(value.z); }
+    void add(const std::string& value);
+    // Field by field, so padding bytes never reach the hash
+    void add(const Material& material);
+    // File name, size and modification time. Nothing is read, so warm starts stay cheap;
+    // a missing file hashes as its name only.
+    void addFile(const std::string& file);
+
+    uint64_t value() const { return hash; }
+
+private:
+    uint64_t hash;
+};
+
+// Binary snapshot of the compiled scene, the tiled block texture mip chains and the decoded skybox.
+// A valid file is mapped read-only and used in place: no parsing and no per-object allocation.
+class SceneCache {
+public:
+    static constexpr uint32_t VERSION = 2;
+
+    SceneCache() = default;
+    ~SceneCache();
+    SceneCache(const SceneCache&) = delete;
+    SceneCache& operator=(const SceneCache&) = delete;
+
+    // Maps the cache file. Returns false when it is missing, from another version, built from other
+    // inputs or holds a material, kernel, texture, mip level or tile index out of range.
+    bool map(const std::string& cacheFile, uint64_t inputHash);
+
+    // Writes a new cache file, replacing the old one atomically.
+    static void write(const std::string& cacheFile, uint64_t inputHash, const Scene& scene,
+                      const TextureTable& textures, const Skybox& skybox);
+
+    const Scene& scene() const { return mapped; }
+    const TextureTable& textures() const { return mappedTextures; }
+    const Uint8* skyboxTexels() const;
+    int skyboxWidth() const { return header->skyboxWidth; }
+    int skyboxHeight() const { return header->skyboxHeight; }
+
+private:
+    void unmap();
+
+    void* data = nullptr;
+    size_t size = 0;
+    const SceneCacheHeader* header = nullptr;
+    Scene mapped;
+    TextureTable mappedTextures;
+};
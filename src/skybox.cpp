@@ -10,6 +10,8 @@ Skybox::~Skybox() {
 }
 
 void Skybox::loadTexture(const std::string& textureFile) {
+    SDL_FreeSurface(texture);
+    texture = nullptr;
     /*
     texture = IMG_Load(textureFile.c_str());
     if (!texture) {
@@ -28,6 +30,14 @@ void Skybox::loadTexture(const std::string& textureFile) {
         throw std::runtime_error("Failed to convert skybox texture to RGB: " + std::string(SDL_GetError()));
     }
     SDL_FreeSurface(rawTexture);
+    useTexels(static_cast<const Uint8*>(texture->pixels), texture->w, texture->h, texture->pitch);
+}
+
+void Skybox::useTexels(const Uint8* texels, int width, int height, int pitch) {
+    pixels = texels;
+    w = width;
+    h = height;
+    rowPitch = pitch;
 }
 
 Color Skybox::getColor(const glm::vec3& direction) const {
@@ -40,16 +50,16 @@ Color Skybox::getColor(const glm::vec3& direction) const {
     float v = theta / M_PI;
     
     // Map texture coordinates to pixel coordinates
-    int x = static_cast<int>(u * texture->w) % texture->w;
-    int y = static_cast<int>(v * texture->h) % texture->h;
+    int x = static_cast<int>(u * w) % w;
+    int y = static_cast<int>(v * h) % h;
     
     // Ensure x and y are within the valid range
-    x = std::max(0, std::min(texture->w - 1, x));
-    y = std::max(0, std::min(texture->h - 1, y));
+    x = std::max(0, std::min(w - 1, x));
+    y = std::max(0, std::min(h - 1, y));
     
     // Get pixel color from texture
     Uint8 r, g, b;
-    Uint8* pixel = &((Uint8*)texture->pixels)[3 * (y * texture->w + x)];
+    const Uint8* pixel = &pixels[y * rowPitch + 3 * x];
     r = pixel[0];
     g = pixel[1];
     b = pixel[2];
@@ -6,12 +6,26 @@
 
 class Skybox {
 public:
+    Skybox() = default;
     Skybox(const std::string& textureFile);
     ~Skybox();
-    
+
+    // Decodes an image file into RGB24 texels owned by the skybox
+    void loadTexture(const std::string& textureFile);
+    // Uses RGB24 texels owned elsewhere (e.g. a mapped scene cache) without copying them
+    void useTexels(const Uint8* texels, int width, int height, int pitch);
+
     Color getColor(const glm::vec3& direction) const;
 
+    const Uint8* texels() const { return pixels; }
+    int width() const { return w; }
+    int height() const { return h; }
+    int pitch() const { return rowPitch; }
+
 private:
-    SDL_Surface* texture;
-    void loadTexture(const std::string& textureFile);
+    SDL_Surface* texture = nullptr;
+    const Uint8* pixels = nullptr;
+    int w = 0;
+    int h = 0;
+    int rowPitch = 0;
 };
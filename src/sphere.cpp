@@ -1,9 +1,20 @@
 #include "sphere.h"
+#include "scene.h"
+#include <algorithm>
 
 Sphere::Sphere(const glm::vec3& center, float radius, const Material& mat)
     : Object(mat), center(center), radius(radius) {}
 
 Intersect Sphere::rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const {
+    return intersect(center, radius, rayOrigin, rayDirection);
+}
+
+void Sphere::appendTo(SceneBuilder& builder) const {
+    builder.addSphere(center, radius, material);
+}
+
+Intersect Sphere::intersect(const glm::vec3& center, float radius,
+                            const glm::vec3& rayOrigin, const glm::vec3& rayDirection) {
     // oc is the vector from the ray's origin to the sphere's center
     glm::vec3 oc = rayOrigin - center;
 
@@ -36,4 +47,12 @@ Intersect Sphere::rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayD
         glm::vec3 normal = glm::normalize(point - center);
         return Intersect(point, normal, dist);
     }
+}
+
+// Spherical mapping: u wraps around the equator, v runs from pole to pole.
+// normal.y is clamped because normalization can push it just past +-1, where acos returns NaN.
+SurfaceUV Sphere::calculateUV(float radius, const Intersect& hit) {
+    float y = std::clamp(hit.normal.y, -1.0f, 1.0f);
+    glm::vec2 uv(0.5f + atan2(hit.normal.z, hit.normal.x) / (2 * M_PI), acos(y) / M_PI);
+    return SurfaceUV{uv, static_cast<float>(1.0f / (2 * M_PI * radius))};
 }
\ No newline at end of file
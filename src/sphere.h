@@ -10,6 +10,14 @@ class Sphere : public Object {
     Sphere(const glm::vec3& center, float radius, const Material& mat);
 
     Intersect rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const override;
+    void appendTo(SceneBuilder& builder) const override;
+
+    // Ray/sphere test shared with the flat scene records
+    static Intersect intersect(const glm::vec3& center, float radius,
+                               const glm::vec3& rayOrigin, const glm::vec3& rayDirection);
+
+    // Maps a hit to spherical texture coordinates
+    static SurfaceUV calculateUV(float radius, const Intersect& hit);
 
   private:
     glm::vec3 center;
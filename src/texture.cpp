@@ -0,0 +1,171 @@
+#include "texture.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+namespace {
+
+Uint32 packTexel(Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255) {
+    return Uint32(r) | (Uint32(g) << 8) | (Uint32(b) << 16) | (Uint32(a) << 24);
+}
+
+Uint8 channel(Uint32 texel, int index) {
+    return static_cast<Uint8>((texel >> (8 * index)) & 0xff);
+}
+
+// Box-filters a level down to half its size (odd edges are clamped).
+std::vector<Uint32> downsample(const std::vector<Uint32>& texels, int width, int height, int newWidth, int newHeight) {
+    std::vector<Uint32> result(newWidth * newHeight);
+    for (int y = 0; y < newHeight; ++y) {
+        for (int x = 0; x < newWidth; ++x) {
+            int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+            int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+            Uint32 quad[4] = {
+                texels[y0 * width + x0], texels[y0 * width + x1],
+                texels[y1 * width + x0], texels[y1 * width + x1]
+            };
+
+            Uint8 averaged[4];
+            for (int c = 0; c < 4; ++c) {
+                int sum = channel(quad[0], c) + channel(quad[1], c) + channel(quad[2], c) + channel(quad[3], c);
+                averaged[c] = static_cast<Uint8>((sum + 2) / 4);
+            }
+            result[y * newWidth + x] = packTexel(averaged[0], averaged[1], averaged[2], averaged[3]);
+        }
+    }
+    return result;
+}
+
+// 16x16 Minecraft-style noise used when a block texture file is missing.
+std::vector<Uint32> noiseTexels(const Color& color, size_t seed, int size) {
+    std::vector<Uint32> texels(size * size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            uint32_t h = static_cast<uint32_t>(x * 73856093 ^ y * 19349663 ^ seed);
+            h = (h ^ (h >> 13)) * 0x5bd1e995;
+            h ^= h >> 15;
+            float shade = 0.8f + 0.3f * static_cast<float>(h & 0xff) / 255.0f;
+            texels[y * size + x] = packTexel(
+                static_cast<Uint8>(std::min(255.0f, color.r * shade)),
+                static_cast<Uint8>(std::min(255.0f, color.g * shade)),
+                static_cast<Uint8>(std::min(255.0f, color.b * shade)));
+        }
+    }
+    return texels;
+}
+
+}
+
+void TextureCache::appendTexture(const std::vector<Uint32>& texels, int width, int height) {
+    TextureRecord record{static_cast<uint32_t>(mipLevels.size()), 0};
+    appendLevel(texels, width, height);
+
+    std::vector<Uint32> current = texels;
+    while (width > 1 || height > 1) {
+        int newWidth = std::max(1, width / 2);
+        int newHeight = std::max(1, height / 2);
+        current = downsample(current, width, height, newWidth, newHeight);
+        width = newWidth;
+        height = newHeight;
+        appendLevel(current, width, height);
+    }
+
+    record.levelCount = static_cast<uint32_t>(mipLevels.size()) - record.firstLevel;
+    textureRecords.push_back(record);
+}
+
+void TextureCache::appendLevel(const std::vector<Uint32>& texels, int width, int height) {
+    MipLevel level{width, height, (width + 3) / 4, static_cast<uint32_t>(tiles.size())};
+    int tilesY = (height + 3) / 4;
+    tiles.resize(tiles.size() + level.tilesX * tilesY, TexelTile{});
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            TexelTile& tile = tiles[level.firstTile + (y >> 2) * level.tilesX + (x >> 2)];
+            tile.texels[(y & 3) * 4 + (x & 3)] = texels[y * width + x];
+        }
+    }
+    mipLevels.push_back(level);
+}
+
+TextureCache::TextureCache([[maybe_unused]] size_t lineCount) {
+#ifdef TEXTURE_CACHE_STATS
+    // Round up to a power of two so the line index is a mask
+    size_t count = 1;
+    while (count < lineCount) count <<= 1;
+    tags.assign(count, nullptr);
+    lineMask = count - 1;
+#endif
+}
+
+int TextureCache::add(const std::string& textureFile, const Color& fallback) {
+    textureFiles.push_back(textureFile);
+    fallbacks.push_back(fallback);
+    return static_cast<int>(textureFiles.size()) - 1;
+}
+
+void TextureCache::decode() {
+    textureRecords.clear();
+    mipLevels.clear();
+    tiles.clear();
+
+    for (size_t i = 0; i < textureFiles.size(); ++i) {
+        const std::string& textureFile = textureFiles[i];
+        SDL_Surface* rawTexture = IMG_Load(textureFile.c_str());
+        SDL_Surface* surface = rawTexture ? SDL_ConvertSurfaceFormat(rawTexture, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+        if (rawTexture) {
+            SDL_FreeSurface(rawTexture);
+        }
+
+        if (!surface) {
+            std::cerr << "Block texture " << textureFile << " not available, using generated texture" << std::endl;
+            const int size = 16;
+            appendTexture(noiseTexels(fallbacks[i], std::hash<std::string>{}(textureFile), size), size, size);
+            continue;
+        }
+
+        std::vector<Uint32> texels(surface->w * surface->h);
+        for (int y = 0; y < surface->h; ++y) {
+            const Uint8* row = static_cast<const Uint8*>(surface->pixels) + y * surface->pitch;
+            for (int x = 0; x < surface->w; ++x) {
+                const Uint8* p = row + 4 * x;
+                texels[y * surface->w + x] = packTexel(p[0], p[1], p[2], p[3]);
+            }
+        }
+        appendTexture(texels, surface->w, surface->h);
+        SDL_FreeSurface(surface);
+    }
+
+    loaded = TextureTable{textureRecords, mipLevels, tiles};
+}
+
+Color TextureCache::sample(int texture, glm::vec2 uv, float footprint) const {
+    const TextureRecord& record = loaded.textures[texture];
+    const MipLevel* chain = &loaded.levels[record.firstLevel];
+
+    // Pick the level whose texel size matches the cone footprint
+    float lod = std::log2(std::max(footprint * chain[0].width, 1.0f));
+    int levelIndex = std::min(static_cast<int>(lod + 0.5f), static_cast<int>(record.levelCount) - 1);
+    const MipLevel& level = chain[levelIndex];
+
+    float u = uv.x - std::floor(uv.x);
+    float v = uv.y - std::floor(uv.y);
+    int x = std::min(static_cast<int>(u * level.width), level.width - 1);
+    int y = std::min(static_cast<int>(v * level.height), level.height - 1);
+
+    const TexelTile* source = &loaded.tiles[level.firstTile + (y >> 2) * level.tilesX + (x >> 2)];
+
+#ifdef TEXTURE_CACHE_STATS
+    size_t line = (reinterpret_cast<uintptr_t>(source) / sizeof(TexelTile)) & lineMask;
+    ++counters.texelFetches;
+    if (tags[line] != source) {
+        ++counters.cacheMisses;
+        tags[line] = source;
+    }
+#endif
+
+    Uint32 texel = source->texels[(y & 3) * 4 + (x & 3)];
+    return Color(channel(texel, 0), channel(texel, 1), channel(texel, 2));
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "color.h"
+
+// 4x4 block of packed RGBA texels. One tile is exactly one 64-byte cache line.
+struct alignas(64) TexelTile {
+    Uint32 texels[16];
+};
+
+// Location of one mip level inside the shared tile array.
+struct MipLevel {
+    int32_t width;
+    int32_t height;
+    int32_t tilesX;
+    uint32_t firstTile;
+};
+
+// A block texture's mip chain inside the shared level array, largest level first.
+struct TextureRecord {
+    uint32_t firstLevel;
+    uint32_t levelCount;
+};
+
+// Every block texture with its full mip chain stored as tiles, so a texel and its
+// neighbours share a cache line instead of being spread across rows.
+// Pointer-free, so the arrays can live in a mapped cache file.
+struct TextureTable {
+    std::span<const TextureRecord> textures;
+    std::span<const MipLevel> levels;
+    std::span<const TexelTile> tiles;
+};
+
+// Texture ids for the three faces of a block (grass-style top/side/bottom). -1 means untextured.
+struct BlockFaces {
+    int top = -1;
+    int side = -1;
+    int bottom = -1;
+
+    BlockFaces() = default;
+    explicit BlockFaces(int all) : top(all), side(all), bottom(all) {}
+    BlockFaces(int top, int side, int bottom) : top(top), side(side), bottom(bottom) {}
+
+    bool operator==(const BlockFaces& other) const = default;
+
+    int forNormal(const glm::vec3& normal) const {
+        if (normal.y > 0.5f) return top;
+        if (normal.y < -0.5f) return bottom;
+        return side;
+    }
+};
+
+struct TextureStats {
+    uint64_t texelFetches = 0;
+    uint64_t cacheMisses = 0;
+};
+
+// Owns every block texture. Files are registered first so materials can hold texture ids, and
+// the tiled mip chains are then either decoded or taken from the scene cache.
+// Texels are read straight from the tiled mip chains, so sampling has no side effects and is
+// safe to call from several threads.
+// Building with TEXTURE_CACHE_STATS adds fetch and miss counters. The misses come from a tag
+// array that simulates a direct-mapped tile cache shared by all textures; they show how well
+// sampling stays on a small set of tiles and are not hardware cache misses. Counting writes
+// to shared state on every sample, so that build is single-threaded only.
+class TextureCache {
+public:
+    explicit TextureCache(size_t lineCount = 2048);
+
+    // Registers an image as a block texture and returns its id. Nothing is read until decode().
+    int add(const std::string& textureFile, const Color& fallback);
+
+    // Loads every registered file and builds its mip chain. When a file cannot be loaded
+    // a procedural noise texture tinted with its `fallback` is generated instead.
+    void decode();
+
+    // Samples from mip chains built earlier, e.g. mapped from the scene cache, instead of decoding.
+    // The arrays must outlive the cache.
+    void useTable(const TextureTable& table) { loaded = table; }
+
+    // Nearest-texel lookup at the mip level that matches a ray-cone footprint.
+    // `footprint` is the cone width at the hit measured in uv units (1.0 spans the whole texture).
+    Color sample(int texture, glm::vec2 uv, float footprint) const;
+
+    // Files in registration order; index i is the file behind texture id i
+    const std::vector<std::string>& files() const { return textureFiles; }
+    const TextureTable& table() const { return loaded; }
+
+#ifdef TEXTURE_CACHE_STATS
+    const TextureStats& stats() const { return counters; }
+    void resetStats() { counters = TextureStats(); }
+#endif
+
+private:
+    std::vector<std::string> textureFiles;
+    std::vector<Color> fallbacks;
+    TextureTable loaded;
+
+    // Storage behind `loaded` after decode()
+    std::vector<TextureRecord> textureRecords;
+    std::vector<MipLevel> mipLevels;
+    std::vector<TexelTile> tiles;
+
+    void appendTexture(const std::vector<Uint32>& texels, int width, int height);
+    void appendLevel(const std::vector<Uint32>& texels, int width, int height);
+#ifdef TEXTURE_CACHE_STATS
+    mutable std::vector<const TexelTile*> tags;
+    size_t lineMask;
+    mutable TextureStats counters;
+#endif
+};